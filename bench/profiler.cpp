@@ -0,0 +1,28 @@
+#include "profiler.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+    void benchmarkRollingStatsPush(benchmark::State& state) {
+        auto stats = RollingStats(state.range(0));
+        double sample = 0;
+        for (auto _ : state) {
+            stats.push(sample);
+            sample += 0.25;
+        }
+        benchmark::DoNotOptimize(stats.samples.data());
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void benchmarkRollingStatsPercentile(benchmark::State& state) {
+        auto stats = RollingStats(state.range(0));
+        for (std::int64_t i = 0; i < state.range(0); ++i)
+            stats.push((i * 7919) % state.range(0));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(stats.percentile(0.99));
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(benchmarkRollingStatsPush)->Arg(FrameProfiler::default_window);
+BENCHMARK(benchmarkRollingStatsPercentile)->RangeMultiplier(4)->Range(64, 16384);
@@ -0,0 +1,32 @@
+#include "scenario.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+    //The only bulk per-particle CPU path so far; items are generated particles
+    void benchmarkMakeScenario(benchmark::State& state, const char* name) {
+        for (auto _ : state) {
+            auto scene = makeScenario(name, state.range(0));
+            benchmark::DoNotOptimize(scene.positions.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    //Worst case: gas to dark matter and back, across the star range both ways
+    void benchmarkChangeType(benchmark::State& state) {
+        auto scene = makeScenario("galaxy-merger", state.range(0));
+        std::size_t gas = 0;
+        for (auto _ : state) {
+            const auto index = scene.changeType(gas, ParticleType::dark_matter);
+            gas = scene.changeType(index, ParticleType::gas);
+            gas = (gas * 7919 + 1) % scene.count(ParticleType::gas);
+        }
+        benchmark::DoNotOptimize(scene.positions.data());
+        state.SetItemsProcessed(2 * state.iterations());
+    }
+}
+
+BENCHMARK_CAPTURE(benchmarkMakeScenario, uniform_box, "uniform-box")->RangeMultiplier(10)->Range(10000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(benchmarkMakeScenario, isolated_disk, "isolated-disk")->RangeMultiplier(10)->Range(10000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(benchmarkMakeScenario, galaxy_merger, "galaxy-merger")->RangeMultiplier(10)->Range(10000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkChangeType)->RangeMultiplier(10)->Range(10000, 1000000);
@@ -0,0 +1,24 @@
+#include "trace.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+    //Buffers are rings, so long runs include the steady state of overwriting old events
+    void benchmarkTraceZone(benchmark::State& state) {
+        for (auto _ : state)
+            VITORE_TRACE_ZONE("benchmark");
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void benchmarkTraceNow(benchmark::State& state) {
+        for (auto _ : state)
+            benchmark::DoNotOptimize(traceNow());
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(benchmarkTraceZone)->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))->UseRealTime();
+BENCHMARK(benchmarkTraceNow);
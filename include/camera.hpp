@@ -0,0 +1,47 @@
+#ifndef _VITORE_CAMERA_HPP
+#define _VITORE_CAMERA_HPP
+
+#include "gl_objects.hpp"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+struct OrbitCamera {
+    glm::vec3 target = glm::vec3(0, 0, 0);
+    float distance = 5.0f;
+    //Angles in radians; yaw around the y axis, pitch towards it
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+
+    float fov = glm::radians(45.0f);
+    float near_plane = 0.01f;
+    float far_plane = 100.0f;
+
+    void rotate(float delta_yaw, float delta_pitch);
+    void zoom(float factor);
+
+    glm::vec3 eye() const;
+    glm::mat4 view() const;
+    glm::mat4 projection(float aspect) const;
+};
+
+//Per-frame camera block, shared by every program through a fixed uniform buffer binding
+struct CameraBuffer {
+    //Must match the binding of the Camera block in the shaders
+    static constexpr GLuint binding = 0;
+
+    //Laid out as std140
+    struct Block {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::vec4 viewport;
+    };
+
+    Buffer buffer;
+
+    CameraBuffer();
+
+    void update(const OrbitCamera& camera, int width, int height) const;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _VITORE_GL_OBJECTS_HPP
+#define _VITORE_GL_OBJECTS_HPP
+
+#include "unique_handle.hpp"
+
+#include <glad/glad.h>
+
+//glad entry points are variables, so they are wrapped to be usable as template arguments
+namespace detail {
+    inline void deleteProgram(GLuint program) { glDeleteProgram(program); }
+    inline void deleteShader(GLuint shader) { glDeleteShader(shader); }
+    inline void deleteSync(GLsync sync) { glDeleteSync(sync); }
+
+    inline void createBuffers(GLsizei n, GLuint* buffers) { glCreateBuffers(n, buffers); }
+    inline void deleteBuffers(GLsizei n, const GLuint* buffers) { glDeleteBuffers(n, buffers); }
+
+    inline void createVertexArrays(GLsizei n, GLuint* arrays) { glCreateVertexArrays(n, arrays); }
+    inline void deleteVertexArrays(GLsizei n, const GLuint* arrays) { glDeleteVertexArrays(n, arrays); }
+
+    template <GLenum target>
+    inline void createTextures(GLsizei n, GLuint* textures) { glCreateTextures(target, n, textures); }
+    inline void deleteTextures(GLsizei n, const GLuint* textures) { glDeleteTextures(n, textures); }
+
+    inline void createFramebuffers(GLsizei n, GLuint* framebuffers) { glCreateFramebuffers(n, framebuffers); }
+    inline void deleteFramebuffers(GLsizei n, const GLuint* framebuffers) { glDeleteFramebuffers(n, framebuffers); }
+
+    template <GLenum target>
+    inline void createQueries(GLsizei n, GLuint* queries) { glCreateQueries(target, n, queries); }
+    inline void deleteQueries(GLsizei n, const GLuint* queries) { glDeleteQueries(n, queries); }
+}
+
+using Program = UniqueHandle<detail::deleteProgram>;
+using Shader = UniqueHandle<detail::deleteShader>;
+//Sync(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0))
+using Sync = BasicUniqueHandle<GLsync, detail::deleteSync>;
+
+using Buffer = UniqueObject<detail::createBuffers, detail::deleteBuffers>;
+using Buffers = UniqueObjects<detail::createBuffers, detail::deleteBuffers>;
+
+using VertexArray = UniqueObject<detail::createVertexArrays, detail::deleteVertexArrays>;
+using VertexArrays = UniqueObjects<detail::createVertexArrays, detail::deleteVertexArrays>;
+
+template <GLenum target>
+using Texture = UniqueObject<detail::createTextures<target>, detail::deleteTextures>;
+template <GLenum target>
+using Textures = UniqueObjects<detail::createTextures<target>, detail::deleteTextures>;
+
+using Framebuffer = UniqueObject<detail::createFramebuffers, detail::deleteFramebuffers>;
+using Framebuffers = UniqueObjects<detail::createFramebuffers, detail::deleteFramebuffers>;
+
+template <GLenum target>
+using Query = UniqueObject<detail::createQueries<target>, detail::deleteQueries>;
+template <GLenum target>
+using Queries = UniqueObjects<detail::createQueries<target>, detail::deleteQueries>;
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef _VITORE_PERF_COUNTERS_HPP
+#define _VITORE_PERF_COUNTERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//Hardware counters of the calling thread through perf_event_open (Linux only,
+//enabled with the `perf_counters` meson option). Whether they can be opened
+//depends on /proc/sys/kernel/perf_event_paranoid.
+struct PerfSample {
+    static constexpr std::size_t count = 4;
+    static constexpr std::array<const char*, count> names = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+    std::array<std::uint64_t, count> values;
+    //Nanoseconds the group was enabled and actually counting
+    std::uint64_t time_enabled;
+    std::uint64_t time_running;
+
+    //Scales the raw deltas by the enabled / running time of the interval itself,
+    //since the cumulative ratio drifts when the PMU is oversubscribed
+    PerfSample operator-(const PerfSample& other) const;
+};
+
+struct PerfCounters {
+    //The first counter leads the group, so all are scheduled together
+    std::array<int, PerfSample::count> fds;
+
+    PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters();
+
+    bool available() const;
+
+    //Raw totals; only differences between samples are scaled for multiplexing
+    PerfSample read() const;
+};
+
+//Counters only count the thread that opened them
+PerfCounters& threadPerfCounters();
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef _VITORE_PROFILER_HPP
+#define _VITORE_PROFILER_HPP
+
+#include "gl_objects.hpp"
+#ifdef VITORE_PERF_COUNTERS
+#include "perf_counters.hpp"
+#endif
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//Fixed-size window of the most recent samples
+struct RollingStats {
+    std::vector<double> samples;
+    std::size_t next = 0;
+    std::size_t capacity;
+
+    explicit RollingStats(std::size_t capacity);
+
+    void push(double sample);
+
+    double min() const;
+    double mean() const;
+    //p in [0, 1]
+    double percentile(double p) const;
+};
+
+//Per-pass GPU (GL_TIME_ELAPSED) and CPU timings over a rolling window of frames.
+//Queries live in a ring of `latency` slots and are read back when their slot is
+//reused, so collecting results never waits on the GPU. Drivers queue a few
+//frames, so results are normally ready by then; the ones that are not are
+//counted as dropped instead of silently biasing the statistics. Passes must not
+//nest. With the `perf_counters` meson option, the hardware counters of the CPU
+//side are recorded as well.
+struct FrameProfiler {
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t latency = 5;
+    static constexpr std::size_t default_window = 240;
+
+    struct Pass {
+        std::string name;
+        Queries<GL_TIME_ELAPSED> queries;
+        std::array<bool, latency> issued;
+        RollingStats gpu;
+        //GPU results that were not ready when their query was reused
+        std::size_t dropped = 0;
+        RollingStats cpu;
+#ifdef VITORE_PERF_COUNTERS
+        std::vector<RollingStats> counters;
+#endif
+
+        Pass(std::string name, std::size_t window);
+    };
+
+    struct Scope {
+        FrameProfiler& profiler;
+        Pass& pass;
+        Clock::time_point start;
+#ifdef VITORE_PERF_COUNTERS
+        PerfSample counters_start;
+#endif
+
+        Scope(FrameProfiler& profiler, Pass& pass);
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+    };
+
+    //When disabled, scopes issue no queries and record nothing
+    bool enabled;
+    //Number of most recent frames the statistics cover
+    std::size_t window;
+    std::vector<Pass> passes;
+    RollingStats frames;
+    std::size_t frame = 0;
+    Clock::time_point frame_start;
+
+    explicit FrameProfiler(bool enabled = true, std::size_t window = default_window);
+
+    //Pass indices stay valid for the lifetime of the profiler
+    std::size_t addPass(std::string name);
+
+    //Collects the results of the queries issued `latency` frames ago
+    void beginFrame();
+    Scope scope(std::size_t pass);
+    //Waits for the queries still in flight and records the last frame, so a
+    //final report includes every frame
+    void finish();
+
+    //Milliseconds as min / mean / p99
+    void print(std::ostream& stream) const;
+    //The same statistics as a JSON object keyed on pass name
+    void printJson(std::ostream& stream) const;
+};
+
+//Peak resident set size of the process in bytes, or 0 where unsupported
+std::size_t peakResidentBytes();
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _VITORE_PROGRAM_CACHE_HPP
+#define _VITORE_PROGRAM_CACHE_HPP
+
+#include "shader.hpp"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+
+//On-disk cache of linked program binaries, keyed on the SPIR-V sources
+//and the driver that produced them. Any failure falls back to a regular
+//compile and link, so the cache never has to be cleared by hand.
+struct ProgramCache {
+    std::filesystem::path directory;
+    //GL_VENDOR, GL_RENDERER and GL_VERSION of the current context
+    std::string driver;
+    bool enabled;
+
+    //Requires a current context
+    explicit ProgramCache(std::filesystem::path directory);
+
+    //$XDG_CACHE_HOME/vitore, ~/.cache/vitore or %LOCALAPPDATA%/vitore
+    static std::filesystem::path defaultDirectory();
+
+    std::uint64_t key(std::span<const ShaderProgram::ShaderSource> sources) const;
+
+    //Returns whether the program was successfully linked from the cache
+    bool load(GLuint program, std::uint64_t key) const;
+    void store(GLuint program, std::uint64_t key) const;
+};
+
+#endif
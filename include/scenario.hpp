@@ -0,0 +1,70 @@
+#ifndef _VITORE_SCENARIO_HPP
+#define _VITORE_SCENARIO_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class ParticleType : std::uint8_t {
+    gas,
+    stars,
+    dark_matter,
+};
+
+constexpr std::size_t particle_type_count = 3;
+
+//Bumped whenever makeScenario produces different particles for the same
+//arguments, so reports from before and after are not compared by mistake
+constexpr std::uint32_t scenario_revision = 2;
+
+//Vertex data is kept compact to halve what drawing streams per particle each frame:
+//12 bytes of position (w is implied) and 4 bytes of normalized colour per particle.
+//Particles are grouped by type in contiguous ranges, so anything working on one
+//type takes its range instead of testing the type of every particle.
+struct Scene {
+    std::vector<glm::vec3> positions;
+    //Independent of the type, which is applied through `tints` when drawing
+    std::vector<glm::u8vec4> colours;
+    //Particles of type t are [offsets[t], offsets[t + 1])
+    std::array<std::size_t, particle_type_count + 1> offsets;
+    std::array<glm::vec3, particle_type_count> tints;
+    GLenum primitive;
+    //Bounding radius around the origin, used to frame the camera
+    float radius;
+
+    std::size_t begin(ParticleType type) const;
+    std::size_t count(ParticleType type) const;
+    ParticleType type(std::size_t index) const;
+
+    //Moves a particle into the range of another type by swapping it across the
+    //range boundaries in between, so a change costs at most
+    //particle_type_count - 1 swaps instead of a full resort. It is drawn with the
+    //tint of its new type. Returns its new index.
+    std::size_t changeType(std::size_t index, ParticleType to);
+};
+
+//Rounds each channel in [0, 1] to 8 bits, opaque
+glm::u8vec4 packColour(glm::vec3 colour);
+
+//The original test triangle
+Scene makeTriangle();
+
+struct UnknownScenario {
+    std::string name;
+};
+
+//Fixed initial conditions for comparing throughput across commits:
+//"uniform-box" (gas only), "isolated-disk" or "galaxy-merger" (gas and stellar
+//disks in dark matter halos). The random numbers are the same everywhere, but the
+//particles also go through libm (log, cos, exp, ...), which is not correctly
+//rounded: they are only identical across builds on one platform and libm version.
+Scene makeScenario(std::string_view name, std::size_t count, std::uint32_t seed = 1);
+
+#endif
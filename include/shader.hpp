@@ -1,12 +1,17 @@
 #ifndef _VITORE_SHADER_HPP
 #define _VITORE_SHADER_HPP
 
-#include "unique_handle.hpp"
+#include "gl_objects.hpp"
 
 #include <glad/glad.h>
 
+#include <cstdint>
+#include <initializer_list>
 #include <span>
 #include <string>
+#include <vector>
+
+struct ProgramCache;
 
 struct ShaderProgram {
     struct CompileError {
@@ -17,16 +22,55 @@ struct ShaderProgram {
         std::string msg;
     };
 
+    //Overrides the default of a `layout(constant_id = index)` constant;
+    //non-integer constants are passed by bit pattern (std::bit_cast)
+    struct SpecializationConstant {
+        GLuint index;
+        GLuint value;
+    };
+
     struct ShaderSource {
         const GLuint* binary;
         const GLsizei length;
         const GLuint type;
+        const std::span<const SpecializationConstant> constants = {};
+    };
+
+    //Submits programs for compilation without waiting on any of them, so the driver
+    //can compile them in parallel (GL_KHR_parallel_shader_compile) while the caller
+    //continues with other startup work. Errors are only reported by finish().
+    struct Batch {
+        struct Pending {
+            Program program;
+            std::vector<Shader> shaders;
+            std::uint64_t key;
+            bool cached;
+        };
+
+        const ProgramCache* cache;
+        std::vector<Pending> pending;
+
+        //With a cache, linked binaries are loaded from or stored to it
+        explicit Batch(const ProgramCache* cache = nullptr);
+
+        //Returns the index of the program in the result of finish()
+        std::size_t add(std::initializer_list<ShaderSource> shaders);
+        std::size_t add(std::span<const ShaderSource> shaders);
+
+        //Whether finish() would not block; always true without GL_KHR_parallel_shader_compile
+        bool ready() const;
+
+        //Waits for all programs and throws the first CompileError or LinkError
+        std::vector<ShaderProgram> finish();
     };
 
-    UniqueHandle<[](GLuint program){ glDeleteProgram(program); }> program;
+    Program program;
 
-    explicit ShaderProgram(std::initializer_list<ShaderSource> shaders);
-    explicit ShaderProgram(std::span<const ShaderSource> shaders);
+    //With a cache, the linked binary is loaded from or stored to it
+    explicit ShaderProgram(std::initializer_list<ShaderSource> shaders, const ProgramCache* cache = nullptr);
+    explicit ShaderProgram(std::span<const ShaderSource> shaders, const ProgramCache* cache = nullptr);
+    //Takes ownership of a linked program
+    explicit ShaderProgram(Program&& program);
 
     void use() const;
 
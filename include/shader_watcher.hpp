@@ -0,0 +1,57 @@
+#ifndef _VITORE_SHADER_WATCHER_HPP
+#define _VITORE_SHADER_WATCHER_HPP
+
+#include "shader.hpp"
+
+#include <glad/glad.h>
+
+#include <filesystem>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <vector>
+
+//Development aid: watches the GLSL sources with inotify, recompiles changed
+//files to SPIR-V with glslangValidator and swaps the programs using them.
+//A program that fails to compile or link keeps running its previous version.
+struct ShaderWatcher {
+    struct WatchedSource {
+        //File name relative to the watched directory
+        std::string file;
+        GLuint type;
+        std::vector<GLuint> binary;
+        std::vector<ShaderProgram::SpecializationConstant> constants;
+    };
+
+    struct WatchedProgram {
+        ShaderProgram* program;
+        std::vector<WatchedSource> sources;
+    };
+
+    struct Source {
+        std::string file;
+        GLuint type;
+        //The SPIR-V the program was built from, used until the file changes
+        std::span<const GLuint> binary;
+        std::span<const ShaderProgram::SpecializationConstant> constants = {};
+    };
+
+    std::filesystem::path directory;
+    std::filesystem::path compiler;
+    int inotify;
+    std::vector<WatchedProgram> programs;
+
+    ShaderWatcher(std::filesystem::path directory, std::filesystem::path compiler);
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+    ~ShaderWatcher();
+
+    //The program must outlive the watcher
+    void watch(ShaderProgram& program, std::initializer_list<Source> sources);
+
+    //Non-blocking; returns whether any program was replaced, in which case
+    //program state such as the bound program has to be restored
+    bool poll();
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef _VITORE_TRACE_HPP
+#define _VITORE_TRACE_HPP
+
+//Scoped zones recorded into per-thread buffers and written as a Chrome trace
+//(chrome://tracing, ui.perfetto.dev). Enabled with the `tracing` meson option;
+//otherwise VITORE_TRACE_ZONE expands to nothing.
+#ifdef VITORE_TRACING
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+struct TraceEvent {
+    //Must have static storage duration, e.g. a string literal
+    const char* name;
+    std::int64_t start;
+    std::int64_t duration;
+};
+
+//Only ever appended to by its own thread; buffers are linked into a lock-free
+//list on first use and live until the end of the process. Long sessions keep the
+//most recent `capacity` events, so recording never reallocates inside a zone.
+//The buffer of an exited thread is handed to the next new thread, so memory is
+//bounded by the peak number of threads, and one tid in the trace can cover
+//several threads that did not overlap.
+struct TraceBuffer {
+    static constexpr std::size_t capacity = 1 << 18;
+
+    std::vector<TraceEvent> events;
+    //Including the events that have since been overwritten
+    std::uint64_t recorded;
+    std::uint32_t thread;
+    TraceBuffer* next;
+
+    void push(const TraceEvent& event);
+};
+
+struct TraceZone {
+    const char* name;
+    std::int64_t start;
+
+    explicit TraceZone(const char* name);
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+    ~TraceZone();
+};
+
+//Nanoseconds since the start of the process
+std::int64_t traceNow();
+TraceBuffer& traceBuffer();
+
+//Other threads must not be recording while the trace is written
+void writeTrace(const std::filesystem::path& path);
+
+//Writes the trace when it goes out of scope, so it is kept on error paths too
+struct TraceWriter {
+    std::filesystem::path path;
+
+    explicit TraceWriter(std::filesystem::path path);
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+    ~TraceWriter();
+};
+
+#define VITORE_TRACE_CONCAT_IMPL(a, b) a##b
+#define VITORE_TRACE_CONCAT(a, b) VITORE_TRACE_CONCAT_IMPL(a, b)
+#define VITORE_TRACE_ZONE(name) TraceZone VITORE_TRACE_CONCAT(trace_zone_, __LINE__)(name)
+
+#else
+
+#define VITORE_TRACE_ZONE(name) ((void) 0)
+
+#endif
+
+#endif
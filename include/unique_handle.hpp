@@ -3,37 +3,116 @@
 
 #include <glad/glad.h>
 
+#include <cstddef>
 #include <utility>
+#include <vector>
+
+template <typename T, void deleter(T)>
+struct BasicUniqueHandle {
+    T handle;
+
+    BasicUniqueHandle(const BasicUniqueHandle&) = delete;
+    BasicUniqueHandle& operator=(const BasicUniqueHandle&) = delete;
+
+    explicit BasicUniqueHandle(T handle):
+        handle(handle) {}
+
+    BasicUniqueHandle(BasicUniqueHandle&& other):
+        handle(std::exchange(other.handle, T())) {}
+
+    BasicUniqueHandle& operator=(BasicUniqueHandle&& other) {
+        std::swap(this->handle, other.handle);
+        return *this;
+    }
+
+    ~BasicUniqueHandle() {
+        if (this->handle != T())
+            deleter(this->handle);
+    }
+
+    operator T() const {
+        return this->handle;
+    }
+
+    T* operator&() {
+        return &this->handle;
+    }
+};
 
 template <void deleter(GLuint)>
-struct UniqueHandle {
+using UniqueHandle = BasicUniqueHandle<GLuint, deleter>;
+
+//A single object of a kind created and deleted by glCreate*(n, ...) and glDelete*(n, ...)
+template <void create(GLsizei, GLuint*), void destroy(GLsizei, const GLuint*)>
+struct UniqueObject {
     GLuint handle;
 
-    UniqueHandle(const UniqueHandle&) = delete;
-    UniqueHandle& operator=(const UniqueHandle&) = delete;
+    UniqueObject(const UniqueObject&) = delete;
+    UniqueObject& operator=(const UniqueObject&) = delete;
 
-    explicit UniqueHandle(GLuint handle):
-        handle(handle) {}
+    UniqueObject() {
+        create(1, &this->handle);
+    }
 
-    UniqueHandle(UniqueHandle&& other):
+    UniqueObject(UniqueObject&& other):
         handle(std::exchange(other.handle, 0)) {}
 
-    UniqueHandle& operator=(UniqueHandle&& other) {
+    UniqueObject& operator=(UniqueObject&& other) {
         std::swap(this->handle, other.handle);
         return *this;
     }
 
-    ~UniqueHandle() {
+    ~UniqueObject() {
         if (this->handle != 0)
-            deleter(this->handle);
+            destroy(1, &this->handle);
     }
 
     operator GLuint() const {
         return this->handle;
     }
+};
 
-    GLuint* operator&() {
-        return &this->handle;
+//Like UniqueObject, but creates and deletes `count` objects with one call each
+template <void create(GLsizei, GLuint*), void destroy(GLsizei, const GLuint*)>
+struct UniqueObjects {
+    std::vector<GLuint> handles;
+
+    UniqueObjects(const UniqueObjects&) = delete;
+    UniqueObjects& operator=(const UniqueObjects&) = delete;
+
+    explicit UniqueObjects(std::size_t count):
+        handles(count) {
+        if (!this->handles.empty())
+            create(this->handles.size(), this->handles.data());
+    }
+
+    UniqueObjects(UniqueObjects&& other):
+        handles(std::exchange(other.handles, {})) {}
+
+    UniqueObjects& operator=(UniqueObjects&& other) {
+        std::swap(this->handles, other.handles);
+        return *this;
+    }
+
+    ~UniqueObjects() {
+        if (!this->handles.empty())
+            destroy(this->handles.size(), this->handles.data());
+    }
+
+    GLuint operator[](std::size_t i) const {
+        return this->handles[i];
+    }
+
+    std::size_t size() const {
+        return this->handles.size();
+    }
+
+    auto begin() const {
+        return this->handles.begin();
+    }
+
+    auto end() const {
+        return this->handles.end();
     }
 };
 
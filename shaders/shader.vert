@@ -3,13 +3,18 @@
 layout(location = 0) in vec4 vertexPosition;
 layout(location = 1) in vec4 vertexColour;
 
-layout(location = 0) uniform mat4 MVP;
+layout(std140, binding = 0) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec4 viewport;
+} camera;
+
+//Per particle type, set before each draw
+layout(location = 0) uniform vec3 tint;
 
 layout(location = 0) out vec4 fragmentColour;
 
 void main(){
-    //gl_Position = MVP * vertexPosition;
-    //Uniforms don't work; grabbed matrix components from main.cpp
-    gl_Position = vec4(1.19506 * vertexPosition.x, 1.79259 * vertexPosition.y, -1.0002 * vertexPosition.z - vertexPosition.w, 4.981 * vertexPosition.z + 5 * vertexPosition.w);
-    fragmentColour = vertexColour;
+    gl_Position = camera.projection * camera.view * vertexPosition;
+    fragmentColour = vec4(tint, 1) * vertexColour;
 }
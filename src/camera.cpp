@@ -0,0 +1,49 @@
+#include "camera.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+void OrbitCamera::rotate(float delta_yaw, float delta_pitch) {
+    this->yaw = std::remainder(this->yaw + delta_yaw, glm::two_pi<float>());
+    //Stay just short of the poles so lookAt keeps a well-defined up vector
+    const float limit = glm::half_pi<float>() - 0.001f;
+    this->pitch = std::clamp(this->pitch + delta_pitch, -limit, limit);
+}
+
+void OrbitCamera::zoom(float factor) {
+    this->distance = std::clamp(this->distance * factor, 2.0f * this->near_plane, 0.5f * this->far_plane);
+}
+
+glm::vec3 OrbitCamera::eye() const {
+    const auto direction = glm::vec3(
+        std::cos(this->pitch) * std::sin(this->yaw),
+        std::sin(this->pitch),
+        std::cos(this->pitch) * std::cos(this->yaw)
+    );
+    return this->target + this->distance * direction;
+}
+
+glm::mat4 OrbitCamera::view() const {
+    return glm::lookAt(this->eye(), this->target, glm::vec3(0, 1, 0));
+}
+
+glm::mat4 OrbitCamera::projection(float aspect) const {
+    return glm::perspective(this->fov, aspect, this->near_plane, this->far_plane);
+}
+
+CameraBuffer::CameraBuffer() {
+    glNamedBufferStorage(this->buffer, sizeof(Block), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, this->buffer);
+}
+
+void CameraBuffer::update(const OrbitCamera& camera, int width, int height) const {
+    const auto block = Block{
+        camera.view(),
+        camera.projection(((float) width) / height),
+        glm::vec4(0, 0, width, height),
+    };
+    glNamedBufferSubData(this->buffer, 0, sizeof(Block), &block);
+}
@@ -1,7 +1,5 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 #include <fmt/ostream.h>
 
 #include <iostream>
@@ -10,78 +8,250 @@
 #include <sstream>
 #include <utility>
 #include <string_view>
+#include <cmath>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <optional>
+#include <array>
 
+#include "build_config.hpp"
+#include "camera.hpp"
+#include "gl_objects.hpp"
+#include "profiler.hpp"
+#include "program_cache.hpp"
+#include "scenario.hpp"
 #include "shader.hpp"
+#include "trace.hpp"
+#include "version.hpp"
+#ifdef VITORE_SHADER_HOT_RELOAD
+#include "shader_watcher.hpp"
+#endif
 #include "shader.frag.h"
 #include "shader.vert.h"
 
-void run(GLFWwindow* window, int width, int height) {
-    auto program = ShaderProgram({
+struct Options {
+    bool borderless = false;
+    //Prints per-pass GPU and CPU timings every few seconds
+    bool profile = false;
+    //Empty for the test triangle
+    std::string scenario;
+    std::size_t particles = 100000;
+    //Non-zero renders this many frames in a hidden window and prints a JSON report
+    std::size_t frames = 0;
+};
+
+void run(GLFWwindow* window, int width, int height, const Options& options) {
+    const auto programCache = ProgramCache(ProgramCache::defaultDirectory());
+
+    //Compiled by the driver while the rest of the scene is set up
+    auto shaderBatch = ShaderProgram::Batch(&programCache);
+    const auto programIndex = shaderBatch.add({
         {shaders_shader_vert, sizeof(shaders_shader_vert), GL_VERTEX_SHADER},
         {shaders_shader_frag, sizeof(shaders_shader_frag), GL_FRAGMENT_SHADER}
     });
-    program.use();
 
-    glm::mat4 projection = glm::perspective(45.0f, ((float) width) / height, 0.01f, 100.0f);
-    glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 5), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
-    glm::mat4 model = glm::mat4(1.0f);
-    glm::mat4 mvp = projection * view * model;
-    //Matrix components in vertex shader
-    /*for(size_t i = 0;i < 4;++i) for(size_t j = 0;j < 4;++j){
-        fmt::print(std::cout, "{}\n", mvp[i][j]);
-    }*/
-    GLuint mvpID = glGetUniformLocation(program, "MVP");
-    glUniformMatrix4fv(mvpID, 1, GL_FALSE, &mvp[0][0]);
+    const auto scene = options.scenario.empty() ? makeTriangle() : makeScenario(options.scenario, options.particles);
+
+    auto camera = OrbitCamera();
+    camera.distance = 2.5f * scene.radius;
+    auto cameraBuffer = CameraBuffer();
+
+    glfwSetWindowUserPointer(window, &camera);
+    glfwSetScrollCallback(window, [](GLFWwindow* window, double, double yOffset) {
+        auto* camera = static_cast<OrbitCamera*>(glfwGetWindowUserPointer(window));
+        camera->zoom(std::pow(0.9f, (float) yOffset));
+    });
+
+    double cursorX, cursorY;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
 
     glEnable(GL_MULTISAMPLE);
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    GLuint vertexArray;
-    glGenVertexArrays(1, &vertexArray);
+    auto vertexArray = VertexArray();
     glBindVertexArray(vertexArray);
 
     glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
 
-    float vertex[] = {-2, -2, 0, 1, 2, -2, 0, 1, 0, 2, 0, 1};
-    float colour[] = {1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 1};
+    auto buffers = Buffers(2);
+    const GLuint vertexBuffer = buffers[0];
+    const GLuint colourBuffer = buffers[1];
+    glNamedBufferStorage(vertexBuffer, scene.positions.size() * sizeof(glm::vec3), scene.positions.data(), 0);
+    glNamedBufferStorage(colourBuffer, scene.colours.size() * sizeof(glm::u8vec4), scene.colours.data(), 0);
 
-    GLuint vertexBuffer;
-    glGenBuffers(1, &vertexBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, vertexBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, 12 * sizeof(float), vertex, GL_STATIC_DRAW);
+    auto programs = shaderBatch.finish();
+    auto& program = programs[programIndex];
+    program.use();
 
-    GLuint colourBuffer;
-    glGenBuffers(1, &colourBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, colourBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, 12 * sizeof(float), colour, GL_STATIC_DRAW);
+#ifdef VITORE_SHADER_HOT_RELOAD
+    auto shaderWatcher = ShaderWatcher(VITORE_SHADER_DIR, VITORE_GLSLANG_VALIDATOR);
+    shaderWatcher.watch(program, {
+        {"shader.vert", GL_VERTEX_SHADER, shaders_shader_vert},
+        {"shader.frag", GL_FRAGMENT_SHADER, shaders_shader_frag}
+    });
+#endif
 
-    while(!glfwWindowShouldClose(window)) {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    //Report runs draw into a framebuffer of their own: the hidden window's pixels fail
+    //the pixel ownership test, so drivers may skip the fragment work being measured
+    auto offscreen = Framebuffer();
+    auto offscreenTargets = Textures<GL_TEXTURE_2D_MULTISAMPLE>(2);
+    if (options.frames > 0) {
+        //Same format as the window: 4 samples, RGBA8 and a 24-bit depth buffer
+        glTextureStorage2DMultisample(offscreenTargets[0], 4, GL_RGBA8, width, height, GL_TRUE);
+        glTextureStorage2DMultisample(offscreenTargets[1], 4, GL_DEPTH_COMPONENT24, width, height, GL_TRUE);
+        glNamedFramebufferTexture(offscreen, GL_COLOR_ATTACHMENT0, offscreenTargets[0], 0);
+        glNamedFramebufferTexture(offscreen, GL_DEPTH_ATTACHMENT, offscreenTargets[1], 0);
+        if (glCheckNamedFramebufferStatus(offscreen, GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, offscreen);
+        else
+            fmt::print(std::cerr, "Could not create an offscreen framebuffer, drawing to the hidden window\n");
+    }
+
+    //Keys 1 to 3 toggle gas, stars and dark matter
+    std::array<bool, particle_type_count> visible;
+    std::array<bool, particle_type_count> keyDown = {};
+    visible.fill(true);
+
+    //Report runs cover every frame, up to a bound on the memory kept per statistic
+    const std::size_t profilerWindow = options.frames > 0 ? std::min<std::size_t>(options.frames, 1 << 16) : FrameProfiler::default_window;
+    auto profiler = FrameProfiler(options.profile || options.frames > 0, profilerWindow);
+    const auto clearPass = profiler.addPass("clear");
+    const auto updatePass = profiler.addPass("update");
+    const auto drawPass = profiler.addPass("draw");
+    const auto swapPass = profiler.addPass("swap");
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t frame = 0;
+    while(!glfwWindowShouldClose(window) && (options.frames == 0 || frame < options.frames)) {
+        ++frame;
+        VITORE_TRACE_ZONE("frame");
+        profiler.beginFrame();
+
+        {
+            VITORE_TRACE_ZONE("clear");
+            auto scope = profiler.scope(clearPass);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
 
-        glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, (void*) 0);
-        glEnableVertexAttribArray(1);
-        glBindBuffer(GL_ARRAY_BUFFER, colourBuffer);
-        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, (void*) 0);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-        glDisableVertexAttribArray(0);
-        glDisableVertexAttribArray(1);
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            VITORE_TRACE_ZONE("update");
+            auto scope = profiler.scope(updatePass);
+
+#ifdef VITORE_SHADER_HOT_RELOAD
+            if (shaderWatcher.poll())
+                program.use();
+#endif
+
+            //Drag with the left mouse button to orbit, scroll to zoom
+            double newCursorX, newCursorY;
+            glfwGetCursorPos(window, &newCursorX, &newCursorY);
+            if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+                const float radiansPerPixel = camera.fov / height;
+                camera.rotate(-(newCursorX - cursorX) * radiansPerPixel, (newCursorY - cursorY) * radiansPerPixel);
+            }
+            cursorX = newCursorX;
+            cursorY = newCursorY;
+
+            for (std::size_t type = 0; type < particle_type_count; ++type) {
+                const bool down = glfwGetKey(window, GLFW_KEY_1 + type) == GLFW_PRESS;
+                if (down && !keyDown[type])
+                    visible[type] = !visible[type];
+                keyDown[type] = down;
+            }
+
+            cameraBuffer.update(camera, width, height);
+        }
+
+        {
+            VITORE_TRACE_ZONE("draw");
+            auto scope = profiler.scope(drawPass);
+            glEnableVertexAttribArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*) 0);
+            glEnableVertexAttribArray(1);
+            glBindBuffer(GL_ARRAY_BUFFER, colourBuffer);
+            glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*) 0);
+            //One draw per type, each with its own tint
+            for (std::size_t i = 0; i < particle_type_count; ++i) {
+                const auto type = (ParticleType) i;
+                if (!visible[i] || scene.count(type) == 0)
+                    continue;
+                glUniform3fv(0, 1, &scene.tints[i].x);
+                glDrawArrays(scene.primitive, scene.begin(type), scene.count(type));
+            }
+            glDisableVertexAttribArray(0);
+            glDisableVertexAttribArray(1);
+        }
+
+        {
+            VITORE_TRACE_ZONE("swap");
+            auto scope = profiler.scope(swapPass);
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        if (options.profile && profiler.frame % profiler.window == 0)
+            profiler.print(std::cout);
     }
 
-    glDeleteBuffers(1, &vertexBuffer);
+    if (options.frames > 0) {
+        //Make sure the last frame is included in the wall time
+        glFinish();
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        profiler.finish();
+        const auto* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+        fmt::print(std::cout, "{{\"version\":\"{}\",\"build\":{{\"buildtype\":\"{}\",\"cpu_arch\":\"{}\",\"lto\":{},\"pgo\":\"{}\"}},"
+            "\"renderer\":\"{}\",\"scenario\":\"{}\",\"scenario_revision\":{},\"particles\":{},\"frames\":{},\"seconds\":{:.6f},"
+            "\"frames_per_second\":{:.3f},\"particles_drawn_per_second\":{:.1f},\"peak_rss_bytes\":{},\"window_frames\":{},\"passes\":",
+            VITORE_VERSION, VITORE_BUILD_TYPE, VITORE_CPU_ARCH, VITORE_LTO ? "true" : "false", VITORE_PGO,
+            renderer != nullptr ? renderer : "", options.scenario.empty() ? "triangle" : options.scenario, scenario_revision, scene.positions.size(), frame, seconds,
+            frame / seconds, scene.positions.size() * frame / seconds, peakResidentBytes(), profiler.window);
+        profiler.printJson(std::cout);
+        fmt::print(std::cout, "}}\n");
+    }
 }
 
 int main(int argc, char** argv) {
-    bool borderless = argc > 1 && std::string(argv[1]) == "borderless";
+    const auto arguments = std::vector<std::string_view>(argv + 1, argv + argc);
+    auto hasArgument = [&](std::string_view argument) {
+        return std::find(arguments.begin(), arguments.end(), argument) != arguments.end();
+    };
+    auto argumentValue = [&](std::string_view key) -> std::optional<std::string_view> {
+        for (const auto argument : arguments) {
+            if (argument.size() > key.size() && argument.starts_with(key) && argument[key.size()] == '=')
+                return argument.substr(key.size() + 1);
+        }
+        return std::nullopt;
+    };
+    auto countArgument = [&](std::string_view key, std::size_t& count) {
+        const auto value = argumentValue(key);
+        if (!value)
+            return true;
+        const auto [end, error] = std::from_chars(value->data(), value->data() + value->size(), count);
+        return error == std::errc() && end == value->data() + value->size();
+    };
+
+    auto options = Options();
+    options.borderless = hasArgument("borderless");
+    options.profile = hasArgument("profile");
+    options.scenario = argumentValue("scenario").value_or("");
+    //An empty scene would leave the vertex buffers without storage
+    if (!countArgument("particles", options.particles) || options.particles == 0 || !countArgument("frames", options.frames)) {
+        fmt::print(std::cerr, "Usage: vitore [borderless] [profile] [scenario=<name>] [particles=<count>] [frames=<count>]\n");
+        return 1;
+    }
+    //Benchmark runs draw offscreen but still need a display (e.g. Xvfb) for GLFW to create the context
+    const bool hidden = options.frames > 0;
+
+#ifdef VITORE_TRACING
+    const auto traceWriter = TraceWriter("vitore-trace.json");
+#endif
 
     int width = 1200, height = 800;
 
@@ -96,9 +266,10 @@ int main(int argc, char** argv) {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_VISIBLE, hidden ? GLFW_FALSE : GLFW_TRUE);
 
     GLFWwindow* window;
-    if (borderless) {
+    if (options.borderless && !hidden) {
         GLFWmonitor* monitor = glfwGetPrimaryMonitor();
         const GLFWvidmode* mode = glfwGetVideoMode(monitor);
         width = mode->width;
@@ -120,7 +291,8 @@ int main(int argc, char** argv) {
 
     glfwMakeContextCurrent(window);
 
-    glfwSwapInterval(1);
+    //Benchmarks measure throughput, not the refresh rate
+    glfwSwapInterval(hidden ? 0 : 1);
 
     gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
 
@@ -129,7 +301,21 @@ int main(int argc, char** argv) {
         fmt::print(std::cerr, "[OpenGL] {}\n", std::string_view(message, length));
     }, nullptr);
 
-    run(window, width, height);
+    try {
+        run(window, width, height, options);
+    } catch (const UnknownScenario& e) {
+        fmt::print(std::cerr, "Unknown scenario '{}', expected uniform-box, isolated-disk or galaxy-merger\n", e.name);
+        glfwTerminate();
+        return 1;
+    } catch (const ShaderProgram::CompileError& e) {
+        fmt::print(std::cerr, "Could not compile shader: {}\n", e.msg);
+        glfwTerminate();
+        return 1;
+    } catch (const ShaderProgram::LinkError& e) {
+        fmt::print(std::cerr, "Could not link program: {}\n", e.msg);
+        glfwTerminate();
+        return 1;
+    }
 
     glfwTerminate();
 
@@ -0,0 +1,94 @@
+#include "perf_counters.hpp"
+
+#include <fmt/ostream.h>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+    constexpr std::array<std::uint64_t, PerfSample::count> configs = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    int openCounter(std::uint64_t config, int group) {
+        auto attributes = perf_event_attr();
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = config;
+        attributes.disabled = group < 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        //This thread, any CPU
+        return syscall(SYS_perf_event_open, &attributes, 0, -1, group, PERF_FLAG_FD_CLOEXEC);
+    }
+}
+
+PerfSample PerfSample::operator-(const PerfSample& other) const {
+    auto difference = PerfSample();
+    difference.time_enabled = this->time_enabled > other.time_enabled ? this->time_enabled - other.time_enabled : 0;
+    difference.time_running = this->time_running > other.time_running ? this->time_running - other.time_running : 0;
+    const bool multiplexed = difference.time_running > 0 && difference.time_running < difference.time_enabled;
+    for (std::size_t i = 0; i < count; ++i) {
+        //Counters only go up, but never let a wrapped difference into the statistics
+        const auto raw = this->values[i] > other.values[i] ? this->values[i] - other.values[i] : 0;
+        difference.values[i] = multiplexed ? (unsigned __int128) raw * difference.time_enabled / difference.time_running : raw;
+    }
+    return difference;
+}
+
+PerfCounters::PerfCounters() {
+    this->fds.fill(-1);
+    for (std::size_t i = 0; i < PerfSample::count; ++i) {
+        this->fds[i] = openCounter(configs[i], this->fds[0]);
+        if (this->fds[i] < 0) {
+            fmt::print(std::cerr, "Could not open hardware counter {}: {}\n", PerfSample::names[i], std::strerror(errno));
+            return;
+        }
+    }
+
+    ioctl(this->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(this->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters() {
+    for (const auto fd : this->fds) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+bool PerfCounters::available() const {
+    return this->fds.back() >= 0;
+}
+
+PerfSample PerfCounters::read() const {
+    auto sample = PerfSample{};
+    if (!this->available())
+        return sample;
+
+    //PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, values[nr]
+    std::uint64_t data[3 + PerfSample::count];
+    if (::read(this->fds[0], data, sizeof(data)) != sizeof(data))
+        return sample;
+
+    sample.time_enabled = data[1];
+    sample.time_running = data[2];
+    for (std::size_t i = 0; i < PerfSample::count; ++i)
+        sample.values[i] = data[3 + i];
+    return sample;
+}
+
+PerfCounters& threadPerfCounters() {
+    thread_local auto counters = PerfCounters();
+    return counters;
+}
@@ -0,0 +1,205 @@
+#include "profiler.hpp"
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace {
+    std::string statsJson(const RollingStats& stats) {
+        return fmt::format("{{\"min\":{:.6f},\"mean\":{:.6f},\"p99\":{:.6f}}}", stats.min(), stats.mean(), stats.percentile(0.99));
+    }
+}
+
+RollingStats::RollingStats(std::size_t capacity):
+    capacity(capacity) {
+    this->samples.reserve(capacity);
+}
+
+void RollingStats::push(double sample) {
+    if (this->samples.size() < this->capacity)
+        this->samples.push_back(sample);
+    else
+        this->samples[this->next] = sample;
+    this->next = (this->next + 1) % this->capacity;
+}
+
+double RollingStats::min() const {
+    if (this->samples.empty())
+        return 0;
+    return *std::min_element(this->samples.begin(), this->samples.end());
+}
+
+double RollingStats::mean() const {
+    if (this->samples.empty())
+        return 0;
+    return std::accumulate(this->samples.begin(), this->samples.end(), 0.0) / this->samples.size();
+}
+
+double RollingStats::percentile(double p) const {
+    if (this->samples.empty())
+        return 0;
+    auto sorted = this->samples;
+    const auto nth = sorted.begin() + std::min<std::size_t>(p * sorted.size(), sorted.size() - 1);
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+FrameProfiler::Pass::Pass(std::string name, std::size_t window):
+    name(std::move(name)),
+    queries(latency),
+    issued{},
+    gpu(window),
+    cpu(window) {
+#ifdef VITORE_PERF_COUNTERS
+    this->counters.assign(PerfSample::count, RollingStats(window));
+#endif
+}
+
+FrameProfiler::Scope::Scope(FrameProfiler& profiler, Pass& pass):
+    profiler(profiler),
+    pass(pass),
+    start(Clock::now()) {
+    if (!profiler.enabled)
+        return;
+    const auto slot = profiler.frame % latency;
+    glBeginQuery(GL_TIME_ELAPSED, pass.queries[slot]);
+    pass.issued[slot] = true;
+#ifdef VITORE_PERF_COUNTERS
+    this->counters_start = threadPerfCounters().read();
+#endif
+}
+
+FrameProfiler::Scope::~Scope() {
+    if (!this->profiler.enabled)
+        return;
+#ifdef VITORE_PERF_COUNTERS
+    const auto counters = threadPerfCounters().read() - this->counters_start;
+    for (std::size_t i = 0; i < PerfSample::count; ++i)
+        this->pass.counters[i].push(counters.values[i]);
+#endif
+    glEndQuery(GL_TIME_ELAPSED);
+    this->pass.cpu.push(std::chrono::duration<double, std::milli>(Clock::now() - this->start).count());
+}
+
+FrameProfiler::FrameProfiler(bool enabled, std::size_t window):
+    enabled(enabled),
+    window(window),
+    frames(window),
+    frame_start(Clock::now()) {}
+
+std::size_t FrameProfiler::addPass(std::string name) {
+    this->passes.emplace_back(std::move(name), this->window);
+    return this->passes.size() - 1;
+}
+
+void FrameProfiler::beginFrame() {
+    if (!this->enabled)
+        return;
+
+    const auto now = Clock::now();
+    if (this->frame > 0)
+        this->frames.push(std::chrono::duration<double, std::milli>(now - this->frame_start).count());
+    this->frame_start = now;
+    ++this->frame;
+
+    //The slot about to be reused was issued `latency` frames ago
+    const auto slot = this->frame % latency;
+    for (auto& pass : this->passes) {
+        if (!pass.issued[slot])
+            continue;
+        pass.issued[slot] = false;
+
+        //Rather drop a sample than stall the pipeline
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(pass.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            ++pass.dropped;
+            continue;
+        }
+
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(pass.queries[slot], GL_QUERY_RESULT, &elapsed);
+        pass.gpu.push(elapsed * 1e-6);
+    }
+}
+
+FrameProfiler::Scope FrameProfiler::scope(std::size_t pass) {
+    return Scope(*this, this->passes[pass]);
+}
+
+void FrameProfiler::finish() {
+    if (!this->enabled || this->frame == 0)
+        return;
+
+    this->frames.push(std::chrono::duration<double, std::milli>(Clock::now() - this->frame_start).count());
+    this->frame_start = Clock::now();
+
+    //Oldest slot first; GL_QUERY_RESULT blocks until each is available
+    for (std::size_t i = 1; i <= latency; ++i) {
+        const auto slot = (this->frame + i) % latency;
+        for (auto& pass : this->passes) {
+            if (!pass.issued[slot])
+                continue;
+            pass.issued[slot] = false;
+
+            GLuint64 elapsed;
+            glGetQueryObjectui64v(pass.queries[slot], GL_QUERY_RESULT, &elapsed);
+            pass.gpu.push(elapsed * 1e-6);
+        }
+    }
+}
+
+void FrameProfiler::print(std::ostream& stream) const {
+    fmt::print(stream, "{:<12} {:>26} {:>8} {:>26}\n", "pass", "GPU min / mean / p99 (ms)", "dropped", "CPU min / mean / p99 (ms)");
+    for (const auto& pass : this->passes) {
+        fmt::print(stream, "{:<12} {:>8.3f} / {:>6.3f} / {:>6.3f} {:>8} {:>8.3f} / {:>6.3f} / {:>6.3f}\n", pass.name,
+            pass.gpu.min(), pass.gpu.mean(), pass.gpu.percentile(0.99), pass.dropped,
+            pass.cpu.min(), pass.cpu.mean(), pass.cpu.percentile(0.99));
+    }
+    fmt::print(stream, "{:<12} {:>26} {:>8} {:>8.3f} / {:>6.3f} / {:>6.3f}\n", "frame", "", "",
+        this->frames.min(), this->frames.mean(), this->frames.percentile(0.99));
+
+#ifdef VITORE_PERF_COUNTERS
+    fmt::print(stream, "{:<12} {:>14} {:>14} {:>6} {:>14} {:>14}\n", "pass", "cycles", "instructions", "IPC", "cache misses", "branch misses");
+    for (const auto& pass : this->passes) {
+        const auto cycles = pass.counters[0].mean();
+        const auto instructions = pass.counters[1].mean();
+        fmt::print(stream, "{:<12} {:>14.0f} {:>14.0f} {:>6.2f} {:>14.0f} {:>14.0f}\n", pass.name, cycles, instructions,
+            cycles > 0 ? instructions / cycles : 0, pass.counters[2].mean(), pass.counters[3].mean());
+    }
+#endif
+}
+
+void FrameProfiler::printJson(std::ostream& stream) const {
+    fmt::print(stream, "{{");
+    for (const auto& pass : this->passes) {
+        fmt::print(stream, "\"{}\":{{\"gpu_ms\":{},\"gpu_dropped\":{},\"cpu_ms\":{}", pass.name, statsJson(pass.gpu), pass.dropped, statsJson(pass.cpu));
+#ifdef VITORE_PERF_COUNTERS
+        for (std::size_t i = 0; i < PerfSample::count; ++i)
+            fmt::print(stream, ",\"{}\":{}", PerfSample::names[i], statsJson(pass.counters[i]));
+#endif
+        fmt::print(stream, "}},");
+    }
+    fmt::print(stream, "\"frame\":{{\"cpu_ms\":{}}}}}", statsJson(this->frames));
+}
+
+std::size_t peakResidentBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    auto usage = rusage();
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * std::size_t(1024);
+#endif
+#else
+    return 0;
+#endif
+}
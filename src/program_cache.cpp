@@ -0,0 +1,130 @@
+#include "program_cache.hpp"
+#include "trace.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+    //FNV-1a; only has to be stable, not cryptographic
+    struct Hasher {
+        std::uint64_t hash = 0xcbf29ce484222325;
+
+        void update(const void* data, std::size_t size) {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i) {
+                this->hash ^= bytes[i];
+                this->hash *= 0x100000001b3;
+            }
+        }
+
+        template <typename T>
+        void update(const T& value) {
+            this->update(&value, sizeof(T));
+        }
+    };
+
+    std::string glString(GLenum name) {
+        const auto* string = reinterpret_cast<const char*>(glGetString(name));
+        return string != nullptr ? string : "";
+    }
+
+    std::filesystem::path cacheFile(const std::filesystem::path& directory, std::uint64_t key) {
+        return directory / fmt::format("{:016x}.bin", key);
+    }
+}
+
+ProgramCache::ProgramCache(std::filesystem::path directory):
+    directory(std::move(directory)),
+    driver(glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION)) {
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    auto error = std::error_code();
+    std::filesystem::create_directories(this->directory, error);
+    this->enabled = formats > 0 && !error;
+}
+
+std::filesystem::path ProgramCache::defaultDirectory() {
+    if (const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME"); xdg_cache_home != nullptr && *xdg_cache_home != 0)
+        return std::filesystem::path(xdg_cache_home) / "vitore";
+    if (const char* home = std::getenv("HOME"); home != nullptr && *home != 0)
+        return std::filesystem::path(home) / ".cache" / "vitore";
+    if (const char* local_app_data = std::getenv("LOCALAPPDATA"); local_app_data != nullptr && *local_app_data != 0)
+        return std::filesystem::path(local_app_data) / "vitore";
+    return std::filesystem::temp_directory_path() / "vitore";
+}
+
+std::uint64_t ProgramCache::key(std::span<const ShaderProgram::ShaderSource> sources) const {
+    auto hasher = Hasher();
+    hasher.update(this->driver.data(), this->driver.size());
+    for (const auto& source : sources) {
+        hasher.update(source.type);
+        hasher.update(source.length);
+        hasher.update(source.binary, source.length);
+        for (const auto& constant : source.constants) {
+            hasher.update(constant.index);
+            hasher.update(constant.value);
+        }
+    }
+    return hasher.hash;
+}
+
+bool ProgramCache::load(GLuint program, std::uint64_t key) const {
+    VITORE_TRACE_ZONE("load program binary");
+    if (!this->enabled)
+        return false;
+
+    auto file = std::ifstream(cacheFile(this->directory, key), std::ios::binary);
+    GLenum format;
+    if (!file.read(reinterpret_cast<char*>(&format), sizeof(format)))
+        return false;
+    auto binary = std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    //Drivers reject binaries from other driver versions or hardware, which leaves the program unlinked
+    glProgramBinary(program, format, binary.data(), binary.size());
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    return ok;
+}
+
+void ProgramCache::store(GLuint program, std::uint64_t key) const {
+    VITORE_TRACE_ZONE("store program binary");
+    if (!this->enabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    auto binary = std::vector<char>(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    //Write to a temporary file first so a concurrent or interrupted run never sees a partial binary.
+    //The name is unique per writer, so runs starting at the same time never write into the same file.
+    const auto path = cacheFile(this->directory, key);
+    auto temporary = path;
+    temporary += fmt::format(".{:08x}.tmp", std::random_device()());
+    auto written = false;
+    {
+        auto file = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(binary.data(), length);
+        file.close();
+        written = !file.fail();
+    }
+    auto error = std::error_code();
+    if (written)
+        std::filesystem::rename(temporary, path, error);
+    if (!written || error)
+        std::filesystem::remove(temporary, error);
+}
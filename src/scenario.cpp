@@ -0,0 +1,174 @@
+#include "scenario.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <numbers>
+#include <random>
+#include <span>
+
+namespace {
+    //std::mt19937 output is fully specified, unlike the standard distributions
+    struct Random {
+        std::mt19937 engine;
+
+        explicit Random(std::uint32_t seed):
+            engine(seed) {}
+
+        //Uniform in (0, 1]
+        float uniform() {
+            return ((this->engine() >> 8) + 1) * 0x1p-24f;
+        }
+    };
+
+    struct Galaxy {
+        glm::vec3 centre;
+        float tilt;
+        glm::vec3 tint;
+    };
+
+    //Exponential surface density with scale length `scale` and a sech^2
+    //vertical profile with scale height `height`, in the xz plane
+    void addDisk(Scene& scene, Random& random, std::size_t count, glm::vec3 centre, float tilt, float scale, float height, glm::vec3 tint) {
+        const float cos_tilt = std::cos(tilt);
+        const float sin_tilt = std::sin(tilt);
+        for (std::size_t i = 0; i < count; ++i) {
+            //The radius of an exponential disk follows a Gamma(2) distribution
+            const float r = -scale * std::log(random.uniform() * random.uniform());
+            const float phi = 2 * std::numbers::pi_v<float> * random.uniform();
+            const float z = height * std::atanh(std::min(2 * random.uniform() - 1, 0.999999f));
+
+            const float x = r * std::cos(phi);
+            const float y = z;
+            const float w = r * std::sin(phi);
+            scene.positions.emplace_back(centre.x + x, centre.y + cos_tilt * y - sin_tilt * w, centre.z + sin_tilt * y + cos_tilt * w);
+
+            //Bright centre fading outwards
+            const float brightness = std::exp(-r / (2 * scale));
+            scene.colours.push_back(packColour((0.3f + 0.7f * brightness) * tint));
+        }
+    }
+
+    //Plummer sphere with scale radius `scale`, truncated at `cutoff`
+    void addHalo(Scene& scene, Random& random, std::size_t count, glm::vec3 centre, float scale, float cutoff, glm::vec3 tint) {
+        //Mass fraction within the cutoff, r^3 / (r^2 + a^2)^(3/2)
+        const float enclosed = std::pow(cutoff / std::hypot(cutoff, scale), 3.0f);
+        for (std::size_t i = 0; i < count; ++i) {
+            //Inverse of the enclosed mass fraction
+            const float r = scale / std::sqrt(std::pow(enclosed * random.uniform(), -2.0f / 3) - 1);
+            const float cos_theta = 2 * random.uniform() - 1;
+            const float sin_theta = std::sqrt(1 - cos_theta * cos_theta);
+            const float phi = 2 * std::numbers::pi_v<float> * random.uniform();
+            scene.positions.push_back(centre + r * glm::vec3(sin_theta * std::cos(phi), cos_theta, sin_theta * std::sin(phi)));
+            scene.colours.push_back(packColour(tint));
+        }
+    }
+
+    //Each component of every galaxy in turn, so the types stay contiguous
+    void addGalaxies(Scene& scene, Random& random, std::size_t count, std::span<const Galaxy> galaxies) {
+        const std::size_t gas = count / 5;
+        const std::size_t stars = 3 * count / 10;
+        const std::size_t dark_matter = count - gas - stars;
+        auto share = [&](std::size_t total, std::size_t i) {
+            return total * (i + 1) / galaxies.size() - total * i / galaxies.size();
+        };
+
+        scene.offsets[0] = 0;
+        for (std::size_t i = 0; i < galaxies.size(); ++i)
+            addDisk(scene, random, share(gas, i), galaxies[i].centre, galaxies[i].tilt, 0.6f, 0.02f, galaxies[i].tint);
+        scene.offsets[1] = scene.positions.size();
+        for (std::size_t i = 0; i < galaxies.size(); ++i)
+            addDisk(scene, random, share(stars, i), galaxies[i].centre, galaxies[i].tilt, 0.5f, 0.05f, galaxies[i].tint);
+        scene.offsets[2] = scene.positions.size();
+        for (std::size_t i = 0; i < galaxies.size(); ++i)
+            addHalo(scene, random, share(dark_matter, i), galaxies[i].centre, 1.5f, 6, glm::vec3(1));
+        scene.offsets[3] = scene.positions.size();
+
+        //Bluer gas and dim dark matter
+        scene.tints = {glm::vec3(0.5f, 0.7f, 1), glm::vec3(1), glm::vec3(0.15f)};
+    }
+}
+
+std::size_t Scene::begin(ParticleType type) const {
+    return this->offsets[(std::size_t) type];
+}
+
+std::size_t Scene::count(ParticleType type) const {
+    return this->offsets[(std::size_t) type + 1] - this->offsets[(std::size_t) type];
+}
+
+ParticleType Scene::type(std::size_t index) const {
+    const auto end = std::upper_bound(this->offsets.begin() + 1, this->offsets.end(), index);
+    return (ParticleType) (end - this->offsets.begin() - 1);
+}
+
+std::size_t Scene::changeType(std::size_t index, ParticleType to) {
+    auto swap = [this](std::size_t a, std::size_t b) {
+        std::swap(this->positions[a], this->positions[b]);
+        std::swap(this->colours[a], this->colours[b]);
+    };
+
+    auto from = (std::size_t) this->type(index);
+    //Moving up: swap with the last particle of the range and shrink it
+    for (; from < (std::size_t) to; ++from) {
+        const auto last = --this->offsets[from + 1];
+        swap(index, last);
+        index = last;
+    }
+    //Moving down: swap with the first particle of the range and grow the one below
+    for (; from > (std::size_t) to; --from) {
+        const auto first = this->offsets[from]++;
+        swap(index, first);
+        index = first;
+    }
+    return index;
+}
+
+glm::u8vec4 packColour(glm::vec3 colour) {
+    auto channel = [](float value) {
+        return (std::uint8_t) std::lround(std::clamp(value, 0.0f, 1.0f) * 255);
+    };
+    return glm::u8vec4(channel(colour.x), channel(colour.y), channel(colour.z), 255);
+}
+
+Scene makeTriangle() {
+    return {
+        {{-2, -2, 0}, {2, -2, 0}, {0, 2, 0}},
+        {{255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}},
+        {0, 3, 3, 3},
+        {glm::vec3(1), glm::vec3(1), glm::vec3(1)},
+        GL_TRIANGLES,
+        2,
+    };
+}
+
+Scene makeScenario(std::string_view name, std::size_t count, std::uint32_t seed) {
+    auto scene = Scene{{}, {}, {}, {glm::vec3(1), glm::vec3(1), glm::vec3(1)}, GL_POINTS, 0};
+    scene.positions.reserve(count);
+    scene.colours.reserve(count);
+    auto random = Random(seed);
+
+    if (name == "uniform-box") {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto position = glm::vec3(random.uniform(), random.uniform(), random.uniform());
+            scene.positions.push_back(4.0f * position - 2.0f);
+            scene.colours.push_back(packColour(position));
+        }
+        scene.offsets = {0, count, count, count};
+        scene.radius = 2 * std::numbers::sqrt3_v<float>;
+    } else if (name == "isolated-disk") {
+        const Galaxy galaxies[] = {{glm::vec3(0, 0, 0), 0, glm::vec3(1, 0.9f, 0.7f)}};
+        addGalaxies(scene, random, count, galaxies);
+        scene.radius = 6;
+    } else if (name == "galaxy-merger") {
+        const Galaxy galaxies[] = {
+            {glm::vec3(-2, 0, 0), 0.5f, glm::vec3(1, 0.8f, 0.6f)},
+            {glm::vec3(2, 0, 0), -1.0f, glm::vec3(0.6f, 0.8f, 1)},
+        };
+        addGalaxies(scene, random, count, galaxies);
+        scene.radius = 8;
+    } else {
+        throw UnknownScenario{std::string(name)};
+    }
+
+    return scene;
+}
@@ -1,18 +1,32 @@
 #include "shader.hpp"
+#include "program_cache.hpp"
+#include "trace.hpp"
 
 #include <utility>
 #include <vector>
 #include <cassert>
 
 namespace {
-    using Shader = UniqueHandle<[](GLuint shader) { glDeleteShader(shader); }>;
-
-    Shader compileShader(const ShaderProgram::ShaderSource& shader_source) {
+    //Only submits the shader; the compile status is checked once the program is linked
+    Shader submitShader(const ShaderProgram::ShaderSource& shader_source) {
         auto shader = Shader(glCreateShader(shader_source.type));
 
         glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, shader_source.binary, shader_source.length);
-        glSpecializeShader(shader, "main", 0, nullptr, nullptr);
 
+        auto constant_indices = std::vector<GLuint>();
+        auto constant_values = std::vector<GLuint>();
+        constant_indices.reserve(shader_source.constants.size());
+        constant_values.reserve(shader_source.constants.size());
+        for (const auto& constant : shader_source.constants) {
+            constant_indices.push_back(constant.index);
+            constant_values.push_back(constant.value);
+        }
+        glSpecializeShader(shader, "main", shader_source.constants.size(), constant_indices.data(), constant_values.data());
+
+        return shader;
+    }
+
+    void checkShader(GLuint shader) {
         GLint ok = GL_FALSE;
         glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
         if (!ok) {
@@ -22,42 +36,114 @@ namespace {
             glGetShaderInfoLog(shader, info_log_length, NULL, msg.data());
             throw ShaderProgram::CompileError{std::move(msg)};
         }
+    }
 
-        return shader;
+    void checkProgram(GLuint program) {
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            GLint info_log_length;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &info_log_length);
+            auto msg = std::string(info_log_length, 0);
+            glGetProgramInfoLog(program, info_log_length, NULL, msg.data());
+            throw ShaderProgram::LinkError{std::move(msg)};
+        }
+    }
+
+    ShaderProgram buildProgram(std::span<const ShaderProgram::ShaderSource> sources, const ProgramCache* cache) {
+        auto batch = ShaderProgram::Batch(cache);
+        batch.add(sources);
+        return std::move(batch.finish().front());
     }
 }
 
-ShaderProgram::ShaderProgram(std::initializer_list<ShaderSource> sources):
-    ShaderProgram(std::span<const ShaderSource>(sources.begin(), sources.end())) {}
+ShaderProgram::Batch::Batch(const ProgramCache* cache):
+    cache(cache) {
+    if (GLAD_GL_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+}
+
+std::size_t ShaderProgram::Batch::add(std::initializer_list<ShaderSource> sources) {
+    return this->add(std::span<const ShaderSource>(sources.begin(), sources.end()));
+}
 
-ShaderProgram::ShaderProgram(std::span<const ShaderSource> sources):
-    program(glCreateProgram()) {
+std::size_t ShaderProgram::Batch::add(std::span<const ShaderSource> sources) {
+    VITORE_TRACE_ZONE("submit program");
+    auto& pending = this->pending.emplace_back(Program(glCreateProgram()), std::vector<Shader>(), 0, false);
 
-    auto shaders = std::vector<Shader>();
-    shaders.reserve(sources.size());
+    if (this->cache != nullptr) {
+        pending.key = this->cache->key(sources);
+        if (this->cache->load(pending.program, pending.key)) {
+            pending.cached = true;
+            return this->pending.size() - 1;
+        }
+        glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    pending.shaders.reserve(sources.size());
     for (const auto& source : sources) {
-        shaders.push_back(compileShader(source));
-        glAttachShader(this->program, shaders.back());
+        pending.shaders.push_back(submitShader(source));
+        glAttachShader(pending.program, pending.shaders.back());
+    }
+
+    glLinkProgram(pending.program);
+
+    return this->pending.size() - 1;
+}
+
+bool ShaderProgram::Batch::ready() const {
+    if (!GLAD_GL_KHR_parallel_shader_compile)
+        return true;
+
+    for (const auto& pending : this->pending) {
+        GLint done = GL_TRUE;
+        if (!pending.cached)
+            glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done)
+            return false;
     }
+    return true;
+}
+
+std::vector<ShaderProgram> ShaderProgram::Batch::finish() {
+    VITORE_TRACE_ZONE("finish programs");
+    auto programs = std::vector<ShaderProgram>();
+    programs.reserve(this->pending.size());
+    for (auto& pending : this->pending) {
+        if (!pending.cached) {
+            //A failed link is most likely caused by a failed compile, which has the more useful log
+            GLint ok = GL_FALSE;
+            glGetProgramiv(pending.program, GL_LINK_STATUS, &ok);
+            if (!ok) {
+                for (const auto& shader : pending.shaders)
+                    checkShader(shader);
+                checkProgram(pending.program);
+            }
+
+            if (this->cache != nullptr)
+                this->cache->store(pending.program, pending.key);
 
-    glLinkProgram(this->program);
+            //AMD drivers bad
+            //for (const auto& shader : pending.shaders) {
+            //    glDetachShader(pending.program, shader);
+            //}
+        }
 
-    GLint ok = GL_FALSE;
-    glGetProgramiv(this->program, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        GLint info_log_length;
-        glGetProgramiv(this->program, GL_INFO_LOG_LENGTH, &info_log_length);
-        auto msg = std::string(info_log_length, 0);
-        glGetProgramInfoLog(this->program, info_log_length, NULL, msg.data());
-        throw ShaderProgram::LinkError{std::move(msg)};
+        programs.emplace_back(std::move(pending.program));
     }
-    
-    //AMD drivers bad
-    //for (const auto& shader : shaders) {
-    //    glDetachShader(this->program, shader);
-    //}
+    this->pending.clear();
+    return programs;
 }
 
+ShaderProgram::ShaderProgram(std::initializer_list<ShaderSource> sources, const ProgramCache* cache):
+    ShaderProgram(std::span<const ShaderSource>(sources.begin(), sources.end()), cache) {}
+
+ShaderProgram::ShaderProgram(std::span<const ShaderSource> sources, const ProgramCache* cache):
+    ShaderProgram(buildProgram(sources, cache)) {}
+
+ShaderProgram::ShaderProgram(Program&& program):
+    program(std::move(program)) {}
+
 void ShaderProgram::use() const {
     assert(this->program != 0);
     glUseProgram(this->program);
@@ -0,0 +1,142 @@
+#include "shader_watcher.hpp"
+#include "trace.hpp"
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <system_error>
+#include <utility>
+
+namespace {
+    std::optional<std::vector<GLuint>> compileSpirv(const std::filesystem::path& compiler, const std::filesystem::path& source) {
+        VITORE_TRACE_ZONE("compile SPIR-V");
+        auto output = std::filesystem::temp_directory_path() / fmt::format("vitore-{}-{}.spv", getpid(), source.filename().string());
+        const auto command = fmt::format("\"{}\" -G --quiet -g -o \"{}\" \"{}\"", compiler.string(), output.string(), source.string());
+        const auto status = std::system(command.c_str());
+
+        auto file = std::ifstream(output, std::ios::binary);
+        auto bytes = std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        file.close();
+        //A failed compile can still leave a partial output behind
+        auto error = std::error_code();
+        std::filesystem::remove(output, error);
+        if (status != 0 || bytes.empty() || bytes.size() % sizeof(GLuint) != 0)
+            return std::nullopt;
+
+        auto binary = std::vector<GLuint>(bytes.size() / sizeof(GLuint));
+        std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(binary.data()));
+        return binary;
+    }
+}
+
+ShaderWatcher::ShaderWatcher(std::filesystem::path directory, std::filesystem::path compiler):
+    directory(std::move(directory)),
+    compiler(std::move(compiler)),
+    inotify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+
+    //Editors either rewrite the file in place or move a new file over it
+    if (this->inotify < 0 || inotify_add_watch(this->inotify, this->directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        fmt::print(std::cerr, "Could not watch {} for shader changes\n", this->directory.string());
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    if (this->inotify >= 0)
+        close(this->inotify);
+}
+
+void ShaderWatcher::watch(ShaderProgram& program, std::initializer_list<Source> sources) {
+    auto& watched = this->programs.emplace_back(&program, std::vector<WatchedSource>());
+    for (const auto& source : sources) {
+        watched.sources.emplace_back(
+            source.file,
+            source.type,
+            std::vector<GLuint>(source.binary.begin(), source.binary.end()),
+            std::vector<ShaderProgram::SpecializationConstant>(source.constants.begin(), source.constants.end())
+        );
+    }
+}
+
+bool ShaderWatcher::poll() {
+    if (this->inotify < 0)
+        return false;
+
+    auto changed = std::set<std::string>();
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(this->inotify, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0)
+                changed.emplace(event->name);
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    auto affected = std::vector<WatchedProgram*>();
+    for (const auto& file : changed) {
+        const auto used = std::any_of(this->programs.begin(), this->programs.end(), [&](const auto& watched) {
+            return std::any_of(watched.sources.begin(), watched.sources.end(), [&](const auto& source) {
+                return source.file == file;
+            });
+        });
+        if (!used)
+            continue;
+
+        fmt::print(std::cerr, "Recompiling {}\n", file);
+        const auto binary = compileSpirv(this->compiler, this->directory / file);
+        if (!binary)
+            continue;
+
+        for (auto& watched : this->programs) {
+            for (auto& source : watched.sources) {
+                if (source.file != file)
+                    continue;
+                source.binary = *binary;
+                if (std::find(affected.begin(), affected.end(), &watched) == affected.end())
+                    affected.push_back(&watched);
+            }
+        }
+    }
+
+    if (affected.empty())
+        return false;
+
+    //Build every affected program before swapping any, so a failure leaves all of them untouched
+    auto batch = ShaderProgram::Batch();
+    for (const auto* watched : affected) {
+        auto sources = std::vector<ShaderProgram::ShaderSource>();
+        for (const auto& source : watched->sources) {
+            sources.push_back({
+                source.binary.data(),
+                (GLsizei) (source.binary.size() * sizeof(GLuint)),
+                source.type,
+                source.constants,
+            });
+        }
+        batch.add(sources);
+    }
+
+    try {
+        auto rebuilt = batch.finish();
+        for (std::size_t i = 0; i < affected.size(); ++i)
+            *affected[i]->program = std::move(rebuilt[i]);
+    } catch (const ShaderProgram::CompileError& e) {
+        fmt::print(std::cerr, "Shader compilation failed, keeping previous programs:\n{}\n", e.msg);
+        return false;
+    } catch (const ShaderProgram::LinkError& e) {
+        fmt::print(std::cerr, "Shader linking failed, keeping previous programs:\n{}\n", e.msg);
+        return false;
+    }
+
+    return true;
+}
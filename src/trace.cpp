@@ -0,0 +1,121 @@
+#include "trace.hpp"
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+    const auto epoch = std::chrono::steady_clock::now();
+
+    std::atomic<TraceBuffer*> buffers = nullptr;
+    std::atomic<std::uint32_t> next_thread = 0;
+
+    TraceBuffer* registerBuffer() {
+        auto* buffer = new TraceBuffer{{}, 0, next_thread++, buffers.load(std::memory_order_relaxed)};
+        buffer->events.reserve(TraceBuffer::capacity);
+        while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+        return buffer;
+    }
+
+    //Buffers of exited threads; threads start and stop rarely, so a lock is fine here
+    std::mutex free_mutex;
+    std::vector<TraceBuffer*> free_buffers;
+
+    struct BufferLease {
+        TraceBuffer* buffer;
+
+        BufferLease() {
+            {
+                auto lock = std::lock_guard(free_mutex);
+                if (!free_buffers.empty()) {
+                    this->buffer = free_buffers.back();
+                    free_buffers.pop_back();
+                    return;
+                }
+            }
+            this->buffer = registerBuffer();
+        }
+
+        BufferLease(const BufferLease&) = delete;
+        BufferLease& operator=(const BufferLease&) = delete;
+
+        ~BufferLease() {
+            auto lock = std::lock_guard(free_mutex);
+            free_buffers.push_back(this->buffer);
+        }
+    };
+
+    //Zone names are string literals in our own code, so only quotes and backslashes need escaping
+    std::string escape(const char* string) {
+        auto escaped = std::string();
+        for (; *string != 0; ++string) {
+            if (*string == '"' || *string == '\\')
+                escaped += '\\';
+            escaped += *string;
+        }
+        return escaped;
+    }
+}
+
+TraceZone::TraceZone(const char* name):
+    name(name),
+    start(traceNow()) {}
+
+TraceZone::~TraceZone() {
+    //Before traceBuffer(), so the first zone of a thread does not include acquiring its buffer
+    const auto end = traceNow();
+    traceBuffer().push({this->name, this->start, end - this->start});
+}
+
+void TraceBuffer::push(const TraceEvent& event) {
+    if (this->events.size() < capacity)
+        this->events.push_back(event);
+    else
+        this->events[this->recorded % capacity] = event;
+    ++this->recorded;
+}
+
+std::int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+TraceBuffer& traceBuffer() {
+    thread_local BufferLease lease;
+    return *lease.buffer;
+}
+
+void writeTrace(const std::filesystem::path& path) {
+    auto file = std::ofstream(path);
+    fmt::print(file, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    auto first = true;
+    std::uint64_t overwritten = 0;
+    for (const auto* buffer = buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+        overwritten += buffer->recorded - buffer->events.size();
+        //Oldest first once the ring has wrapped
+        const auto oldest = buffer->recorded > TraceBuffer::capacity ? buffer->recorded % TraceBuffer::capacity : 0;
+        for (std::size_t i = 0; i < buffer->events.size(); ++i) {
+            const auto& event = buffer->events[(oldest + i) % buffer->events.size()];
+            fmt::print(file, "{}\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                first ? "" : ",", escape(event.name), buffer->thread, event.start * 1e-3, event.duration * 1e-3);
+            first = false;
+        }
+    }
+    fmt::print(file, "\n]}}\n");
+
+    if (overwritten > 0)
+        fmt::print(std::cerr, "Trace {} is missing the {} oldest events\n", path.string(), overwritten);
+}
+
+TraceWriter::TraceWriter(std::filesystem::path path):
+    path(std::move(path)) {}
+
+TraceWriter::~TraceWriter() {
+    writeTrace(this->path);
+}